@@ -0,0 +1,35 @@
+# Converts a SPIR-V binary into a C++ source file defining a word array
+# Usage: cmake -DINPUT=<spv> -DOUTPUT=<cpp> -DIDENTIFIER=<name> -P <this file>
+
+file(READ ${INPUT} hex HEX)
+
+string(LENGTH "${hex}" hex_length)
+math(EXPR remainder "${hex_length} % 8")
+if(hex_length EQUAL 0 OR NOT remainder EQUAL 0)
+    message(FATAL_ERROR "${INPUT} is not a valid SPIR-V binary")
+endif()
+
+# SPIR-V is a little endian word stream, so reverse the bytes of each word
+string(REGEX REPLACE "(..)(..)(..)(..)" "0x\\4\\3\\2\\1u, " words "${hex}")
+string(REPEAT "0x........u, " 5 line)
+string(REGEX REPLACE "(${line})" "\\1\n" words "${words}")
+string(STRIP "${words}" words)
+string(REPLACE ", \n" ",\n            " words "${words}")
+
+get_filename_component(input_name ${INPUT} NAME)
+
+file(WRITE ${OUTPUT} "\
+// Generated from ${input_name}, do not edit
+
+#include \"vulkan/shaders.hpp\"
+
+namespace glowstick::vulkan::shaders {
+    namespace {
+        constexpr std::uint32_t ${IDENTIFIER}_words[]{
+            ${words}
+        };
+    }
+
+    const std::span<const std::uint32_t> ${IDENTIFIER}(${IDENTIFIER}_words);
+}
+")
@@ -1,8 +1,52 @@
 #pragma once
 
 #include <memory>
+#include <functional>
+#include <filesystem>
+#include <span>
+#include <cstdint>
+#include <cstddef>
 
 namespace glowstick {
+    // Each distinct combination builds its own pipeline variant the first
+    // time it is used
+    struct render_settings {
+        std::uint32_t max_bounces = 4;
+        std::uint32_t samples_per_pixel = 16;
+        bool russian_roulette = true;
+    };
+
+    struct tiled_render_info {
+        std::uint32_t width;
+        std::uint32_t height;
+        // Peak device memory grows with the square of the tile size and does
+        // not depend on the image size
+        std::uint32_t tile_size = 1024;
+        render_settings settings;
+    };
+
+    // A completed tile of RGBA8 pixels with tightly packed rows
+    // The pixels are only valid until the sink returns
+    struct tile {
+        std::uint32_t x;
+        std::uint32_t y;
+        std::uint32_t width;
+        std::uint32_t height;
+        std::span<const std::byte> pixels;
+    };
+
+    // Called in row major tile order while the following tiles render
+    using tile_sink = std::function<void(const tile&)>;
+
+    struct render_stats {
+        std::size_t tile_count;
+        double seconds;
+        double tiles_per_second;
+        std::uint64_t peak_device_memory;
+        // Pipeline variants built so far, one per distinct render_settings
+        std::size_t pipeline_variants;
+    };
+
     class renderer {
     public:
         renderer();
@@ -12,6 +56,12 @@ namespace glowstick {
 
         ~renderer();
 
+        render_stats render_tiled(const tiled_render_info& info,
+            const tile_sink& sink);
+        // Streams the tiles into a memory mapped PAM image
+        render_stats render_tiled(const tiled_render_info& info,
+            const std::filesystem::path& path);
+
     private:
         struct impl;
         std::unique_ptr<impl> p_impl;
@@ -0,0 +1,135 @@
+#include "mapped_file.hpp"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+#include <cstdint>
+
+#include "glowstick/error.hpp"
+
+namespace glowstick {
+#ifdef _WIN32
+    mapped_file::mapped_file(const std::filesystem::path& path,
+        std::size_t size) :
+        file_handle(INVALID_HANDLE_VALUE),
+        mapping_handle(nullptr)
+    {
+        file_handle = CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE,
+            0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if(file_handle == INVALID_HANDLE_VALUE)
+            throw error("failed to create output file");
+
+        // Creating the mapping also grows the file to the mapping size
+        std::uint64_t mapping_size = size;
+        mapping_handle = CreateFileMappingW(file_handle, nullptr,
+            PAGE_READWRITE, static_cast<DWORD>(mapping_size >> 32),
+            static_cast<DWORD>(mapping_size), nullptr);
+        if(!mapping_handle) {
+            CloseHandle(file_handle);
+            throw error("failed to map output file");
+        }
+
+        void* view = MapViewOfFile(mapping_handle, FILE_MAP_WRITE, 0, 0,
+            size);
+        if(!view) {
+            CloseHandle(mapping_handle);
+            CloseHandle(file_handle);
+            throw error("failed to map output file");
+        }
+
+        data = std::span(static_cast<std::byte*>(view), size);
+    }
+
+    mapped_file::mapped_file(mapped_file&& other) noexcept :
+        file_handle(other.file_handle),
+        mapping_handle(other.mapping_handle),
+        data(other.data)
+    {
+        other.file_handle = INVALID_HANDLE_VALUE;
+        other.mapping_handle = nullptr;
+        other.data = {};
+    }
+
+    mapped_file& mapped_file::operator=(mapped_file&& other) noexcept {
+        file_handle = other.file_handle;
+        other.file_handle = INVALID_HANDLE_VALUE;
+
+        mapping_handle = other.mapping_handle;
+        other.mapping_handle = nullptr;
+
+        data = other.data;
+        other.data = {};
+
+        return *this;
+    }
+
+    mapped_file::~mapped_file() {
+        if(file_handle == INVALID_HANDLE_VALUE)
+            return;
+
+        UnmapViewOfFile(data.data());
+        CloseHandle(mapping_handle);
+        CloseHandle(file_handle);
+    }
+#else
+    mapped_file::mapped_file(const std::filesystem::path& path,
+        std::size_t size) :
+        file_descriptor(-1)
+    {
+        file_descriptor = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC,
+            0644);
+        if(file_descriptor == -1)
+            throw error("failed to create output file");
+
+        if(ftruncate(file_descriptor, static_cast<off_t>(size)) == -1) {
+            close(file_descriptor);
+            throw error("failed to resize output file");
+        }
+
+        void* view = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+            file_descriptor, 0);
+        if(view == MAP_FAILED) {
+            close(file_descriptor);
+            throw error("failed to map output file");
+        }
+
+        data = std::span(static_cast<std::byte*>(view), size);
+    }
+
+    mapped_file::mapped_file(mapped_file&& other) noexcept :
+        file_descriptor(other.file_descriptor),
+        data(other.data)
+    {
+        other.file_descriptor = -1;
+        other.data = {};
+    }
+
+    mapped_file& mapped_file::operator=(mapped_file&& other) noexcept {
+        file_descriptor = other.file_descriptor;
+        other.file_descriptor = -1;
+
+        data = other.data;
+        other.data = {};
+
+        return *this;
+    }
+
+    mapped_file::~mapped_file() {
+        if(file_descriptor == -1)
+            return;
+
+        munmap(data.data(), data.size());
+        close(file_descriptor);
+    }
+#endif
+
+    std::span<std::byte> mapped_file::get_data() const noexcept {
+        return data;
+    }
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <filesystem>
+#include <span>
+#include <cstddef>
+
+namespace glowstick {
+    // A file created with a fixed size and mapped into memory for writing
+    // The operating system pages the contents out as needed, so the file can be
+    // larger than the available memory
+    class mapped_file {
+    public:
+        explicit mapped_file(const std::filesystem::path& path,
+            std::size_t size);
+        mapped_file(const mapped_file&) = delete;
+        mapped_file(mapped_file&& other) noexcept;
+
+        mapped_file& operator=(const mapped_file&) = delete;
+        mapped_file& operator=(mapped_file&& other) noexcept;
+
+        ~mapped_file();
+
+        std::span<std::byte> get_data() const noexcept;
+
+    private:
+    #ifdef _WIN32
+        void* file_handle;
+        void* mapping_handle;
+    #else
+        int file_descriptor;
+    #endif
+        std::span<std::byte> data;
+    };
+}
@@ -1,10 +1,46 @@
 #include "glowstick/renderer.hpp"
+
+#include <optional>
+#include <functional>
+#include <string>
+#include <chrono>
+#include <cstring>
+
+#include "glowstick/error.hpp"
+#include "mapped_file.hpp"
 #include "vulkan/context.hpp"
+#include "vulkan/trace_kernel.hpp"
+#include "vulkan/tile_renderer.hpp"
 
 namespace glowstick {
+    namespace {
+        void validate(const tiled_render_info& info) {
+            if(info.width == 0 || info.height == 0)
+                throw error("tried to render an empty image");
+            if(info.tile_size == 0)
+                throw error("tried to render with an empty tile size");
+            if(info.settings.samples_per_pixel == 0)
+                throw error("tried to render without any samples");
+        }
+    }
+
     struct renderer::impl {
         vulkan::context context;
         std::vector<vulkan::device> devices;
+        // Created on first use so pipeline variants outlive a single render
+        std::optional<vulkan::trace_kernel> trace_kernel;
+
+        vulkan::device& get_device() {
+            if(devices.empty())
+                throw error("could not find a suitable device");
+
+            return devices.front();
+        }
+
+        // Everything that can fail is set up before make_sink is called, so
+        // the sink can defer side effects until the render is ready to go
+        render_stats render(const tiled_render_info& info,
+            const std::function<tile_sink()>& make_sink);
     };
 
     renderer::renderer() :
@@ -14,4 +50,86 @@ namespace glowstick {
     }
 
     renderer::~renderer() = default;
+
+    render_stats renderer::impl::render(const tiled_render_info& info,
+        const std::function<tile_sink()>& make_sink)
+    {
+        validate(info);
+
+        vulkan::device& device = get_device();
+
+        if(!trace_kernel)
+            trace_kernel.emplace(device.get_handle());
+
+        device.reset_peak_allocated_memory();
+
+        // Only time the tiles, not the buffer setup or pipeline compilation
+        std::size_t tile_count;
+        std::chrono::duration<double> elapsed;
+        {
+            vulkan::tile_renderer tile_renderer(device, *trace_kernel, info);
+
+            tile_sink sink = make_sink();
+
+            auto start = std::chrono::steady_clock::now();
+
+            tile_count = tile_renderer.render(sink);
+
+            elapsed = std::chrono::steady_clock::now() - start;
+        }
+
+        return {
+            .tile_count = tile_count,
+            .seconds = elapsed.count(),
+            .tiles_per_second = elapsed.count() > 0.0
+                ? static_cast<double>(tile_count) / elapsed.count() : 0.0,
+            .peak_device_memory = device.get_peak_allocated_memory(),
+            .pipeline_variants = trace_kernel->get_pipeline_count()
+        };
+    }
+
+    render_stats renderer::render_tiled(const tiled_render_info& info,
+        const tile_sink& sink)
+    {
+        return p_impl->render(info, [&] { return sink; });
+    }
+
+    render_stats renderer::render_tiled(const tiled_render_info& info,
+        const std::filesystem::path& path)
+    {
+        std::optional<mapped_file> file;
+
+        // The file is only created once the render is set up, so a render
+        // that cannot start leaves an existing file untouched
+        return p_impl->render(info, [&]() -> tile_sink {
+            // PAM keeps the RGBA8 tiles as they are behind a plain text header
+            std::string header = "P7\nWIDTH " + std::to_string(info.width)
+                + "\nHEIGHT " + std::to_string(info.height)
+                + "\nDEPTH 4\nMAXVAL 255\nTUPLTYPE RGB_ALPHA\nENDHDR\n";
+
+            std::size_t row_size = static_cast<std::size_t>(info.width) * 4;
+
+            file.emplace(path, header.size()
+                + row_size * static_cast<std::size_t>(info.height));
+
+            std::span<std::byte> data = file->get_data();
+            std::memcpy(data.data(), header.data(), header.size());
+
+            std::span<std::byte> pixels = data.subspan(header.size());
+
+            return [pixels, row_size](const tile& finished_tile) {
+                std::size_t tile_row_size =
+                    static_cast<std::size_t>(finished_tile.width) * 4;
+
+                for(std::uint32_t row = 0; row < finished_tile.height; ++row)
+                {
+                    std::memcpy(
+                        pixels.data() + (finished_tile.y + row) * row_size
+                            + static_cast<std::size_t>(finished_tile.x) * 4,
+                        finished_tile.pixels.data() + row * tile_row_size,
+                        tile_row_size);
+                }
+            };
+        });
+    }
 }
@@ -2,12 +2,15 @@
 
 #include <vector>
 #include <array>
+#include <algorithm>
 
 #include "vulkan/error.hpp"
 
 namespace glowstick::vulkan {
     device::device(VkPhysicalDevice vk_physical_device) :
-        vk_device(VK_NULL_HANDLE)
+        vk_device(VK_NULL_HANDLE),
+        allocated_memory(0),
+        peak_allocated_memory(0)
     {
         VkResult result;
 
@@ -17,6 +20,11 @@ namespace glowstick::vulkan {
         vkGetPhysicalDeviceProperties(vk_physical_device, &device_properties);
 
         device_name = device_properties.deviceName;
+        max_storage_buffer_range =
+            device_properties.limits.maxStorageBufferRange;
+
+        vkGetPhysicalDeviceMemoryProperties(vk_physical_device,
+            &memory_properties);
 
         // Get queue families
 
@@ -155,6 +163,10 @@ namespace glowstick::vulkan {
     device::device(device&& other) noexcept :
         vk_device(other.vk_device),
         device_name(std::move(other.device_name)),
+        memory_properties(other.memory_properties),
+        max_storage_buffer_range(other.max_storage_buffer_range),
+        allocated_memory(other.allocated_memory),
+        peak_allocated_memory(other.peak_allocated_memory),
         graphics_queue(std::move(other.graphics_queue)),
         compute_queue(std::move(other.compute_queue)),
         transfer_queue(std::move(other.transfer_queue))
@@ -171,6 +183,10 @@ namespace glowstick::vulkan {
         other.vk_device = VK_NULL_HANDLE;
 
         device_name = std::move(other.device_name);
+        memory_properties = other.memory_properties;
+        max_storage_buffer_range = other.max_storage_buffer_range;
+        allocated_memory = other.allocated_memory;
+        peak_allocated_memory = other.peak_allocated_memory;
 
         graphics_queue = std::move(other.graphics_queue);
         other.graphics_queue.reset();
@@ -186,7 +202,90 @@ namespace glowstick::vulkan {
         vkDestroyDevice(vk_device, nullptr);
     }
 
+    VkDevice device::get_handle() const noexcept {
+        return vk_device;
+    }
+
     std::string_view device::get_name() const noexcept {
         return device_name;
     }
+
+    const queue& device::get_graphics_queue() const noexcept {
+        return *graphics_queue;
+    }
+
+    VkDeviceSize device::get_max_storage_buffer_range() const noexcept {
+        return max_storage_buffer_range;
+    }
+
+    VkDeviceMemory device::allocate_memory(
+        const VkMemoryRequirements& requirements,
+        VkMemoryPropertyFlags required_flags,
+        VkMemoryPropertyFlags preferred_flags)
+    {
+        // Find a memory type, falling back to the first one that only has the
+        // required flags
+
+        std::optional<std::uint32_t> type_index;
+        for(std::uint32_t index = 0; index < memory_properties.memoryTypeCount;
+            ++index)
+        {
+            if(!(requirements.memoryTypeBits & (1u << index)))
+                continue;
+
+            VkMemoryPropertyFlags flags =
+                memory_properties.memoryTypes[index].propertyFlags;
+
+            if((flags & required_flags) != required_flags)
+                continue;
+
+            if((flags & preferred_flags) == preferred_flags) {
+                type_index = index;
+                break;
+            }
+
+            if(!type_index)
+                type_index = index;
+        }
+
+        if(!type_index)
+            throw glowstick::error("failed to find a suitable memory type");
+
+        VkMemoryAllocateInfo allocate_info{
+            .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+            .allocationSize = requirements.size,
+            .memoryTypeIndex = type_index.value()
+        };
+
+        VkDeviceMemory vk_memory;
+        VkResult result = vkAllocateMemory(vk_device, &allocate_info, nullptr,
+            &vk_memory);
+        if(result != VK_SUCCESS)
+            throw error(result, "failed to allocate device memory");
+
+        allocated_memory += requirements.size;
+        peak_allocated_memory = std::max(peak_allocated_memory,
+            allocated_memory);
+
+        return vk_memory;
+    }
+
+    void device::free_memory(VkDeviceMemory vk_memory,
+        VkDeviceSize size) noexcept
+    {
+        vkFreeMemory(vk_device, vk_memory, nullptr);
+        allocated_memory -= size;
+    }
+
+    VkDeviceSize device::get_allocated_memory() const noexcept {
+        return allocated_memory;
+    }
+
+    VkDeviceSize device::get_peak_allocated_memory() const noexcept {
+        return peak_allocated_memory;
+    }
+
+    void device::reset_peak_allocated_memory() noexcept {
+        peak_allocated_memory = allocated_memory;
+    }
 }
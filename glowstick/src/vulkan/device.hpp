@@ -19,11 +19,29 @@ namespace glowstick::vulkan {
 
         ~device();
 
+        VkDevice get_handle() const noexcept;
         std::string_view get_name() const noexcept;
+        const queue& get_graphics_queue() const noexcept;
+        VkDeviceSize get_max_storage_buffer_range() const noexcept;
+
+        // Allocations are tracked so callers can report their memory footprint
+        // A memory type with all the preferred flags is picked if there is one
+        VkDeviceMemory allocate_memory(const VkMemoryRequirements& requirements,
+            VkMemoryPropertyFlags required_flags,
+            VkMemoryPropertyFlags preferred_flags);
+        void free_memory(VkDeviceMemory vk_memory, VkDeviceSize size) noexcept;
+
+        VkDeviceSize get_allocated_memory() const noexcept;
+        VkDeviceSize get_peak_allocated_memory() const noexcept;
+        void reset_peak_allocated_memory() noexcept;
 
     private:
         VkDevice vk_device;
         std::string device_name;
+        VkPhysicalDeviceMemoryProperties memory_properties;
+        VkDeviceSize max_storage_buffer_range;
+        VkDeviceSize allocated_memory;
+        VkDeviceSize peak_allocated_memory;
         std::optional<queue> graphics_queue;
         std::optional<queue> compute_queue;
         std::optional<queue> transfer_queue;
@@ -0,0 +1,167 @@
+#include "vulkan/permutation_cache.hpp"
+
+#include "glowstick/error.hpp"
+#include "vulkan/error.hpp"
+
+namespace glowstick::vulkan {
+    permutation_cache::permutation_cache(VkDevice vk_device,
+        std::span<const std::uint32_t> code,
+        VkPipelineLayout vk_pipeline_layout) :
+        vk_device(vk_device),
+        vk_shader_module(VK_NULL_HANDLE),
+        vk_pipeline_cache(VK_NULL_HANDLE),
+        vk_pipeline_layout(vk_pipeline_layout)
+    {
+        VkResult result;
+
+        // Create the shader module once, every variant shares it
+
+        VkShaderModuleCreateInfo shader_module_create_info{
+            .sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+            .codeSize = code.size_bytes(),
+            .pCode = code.data()
+        };
+
+        result = vkCreateShaderModule(vk_device, &shader_module_create_info,
+            nullptr, &vk_shader_module);
+        if(result != VK_SUCCESS)
+            throw error(result, "failed to create shader module");
+
+        // The driver can reuse work between variants through the pipeline
+        // cache
+
+        VkPipelineCacheCreateInfo pipeline_cache_create_info{
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO
+        };
+
+        result = vkCreatePipelineCache(vk_device, &pipeline_cache_create_info,
+            nullptr, &vk_pipeline_cache);
+        if(result != VK_SUCCESS) {
+            vkDestroyShaderModule(vk_device, vk_shader_module, nullptr);
+            throw error(result, "failed to create pipeline cache");
+        }
+    }
+
+    permutation_cache::permutation_cache(permutation_cache&& other) noexcept :
+        vk_device(other.vk_device),
+        vk_shader_module(other.vk_shader_module),
+        vk_pipeline_cache(other.vk_pipeline_cache),
+        vk_pipeline_layout(other.vk_pipeline_layout),
+        pipelines(std::move(other.pipelines))
+    {
+        other.vk_device = VK_NULL_HANDLE;
+        other.vk_shader_module = VK_NULL_HANDLE;
+        other.vk_pipeline_cache = VK_NULL_HANDLE;
+        other.vk_pipeline_layout = VK_NULL_HANDLE;
+
+        other.pipelines.clear();
+    }
+
+    permutation_cache& permutation_cache::operator=(
+        permutation_cache&& other) noexcept
+    {
+        vk_device = other.vk_device;
+        other.vk_device = VK_NULL_HANDLE;
+
+        vk_shader_module = other.vk_shader_module;
+        other.vk_shader_module = VK_NULL_HANDLE;
+
+        vk_pipeline_cache = other.vk_pipeline_cache;
+        other.vk_pipeline_cache = VK_NULL_HANDLE;
+
+        vk_pipeline_layout = other.vk_pipeline_layout;
+        other.vk_pipeline_layout = VK_NULL_HANDLE;
+
+        pipelines = std::move(other.pipelines);
+        other.pipelines.clear();
+
+        return *this;
+    }
+
+    permutation_cache::~permutation_cache() {
+        if(vk_device == VK_NULL_HANDLE)
+            return;
+
+        for(auto& [constants, vk_pipeline] : pipelines)
+            vkDestroyPipeline(vk_device, vk_pipeline, nullptr);
+
+        vkDestroyPipelineCache(vk_device, vk_pipeline_cache, nullptr);
+        vkDestroyShaderModule(vk_device, vk_shader_module, nullptr);
+    }
+
+    VkPipeline permutation_cache::get(
+        std::span<const std::uint32_t> constants)
+    {
+        if(vk_device == VK_NULL_HANDLE)
+            throw glowstick::error("tried to use an empty permutation cache");
+
+        std::vector<std::uint32_t> key(constants.begin(), constants.end());
+
+        auto it = pipelines.find(key);
+        if(it != pipelines.end())
+            return it->second;
+
+        // Create the variant
+
+        std::vector<VkSpecializationMapEntry> map_entries;
+        map_entries.reserve(key.size());
+        for(std::uint32_t constant_id = 0;
+            constant_id < static_cast<std::uint32_t>(key.size());
+            ++constant_id)
+        {
+            map_entries.push_back({
+                .constantID = constant_id,
+                .offset = constant_id
+                    * static_cast<std::uint32_t>(sizeof(std::uint32_t)),
+                .size = sizeof(std::uint32_t)
+            });
+        }
+
+        VkSpecializationInfo specialization_info{
+            .mapEntryCount = static_cast<std::uint32_t>(map_entries.size()),
+            .pMapEntries = map_entries.data(),
+            .dataSize = key.size() * sizeof(std::uint32_t),
+            .pData = key.data()
+        };
+
+        VkComputePipelineCreateInfo pipeline_create_info{
+            .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+            .stage = {
+                .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+                .stage = VK_SHADER_STAGE_COMPUTE_BIT,
+                .module = vk_shader_module,
+                .pName = "main",
+                .pSpecializationInfo = &specialization_info
+            },
+            .layout = vk_pipeline_layout
+        };
+
+        VkPipeline vk_pipeline;
+        VkResult result = vkCreateComputePipelines(vk_device,
+            vk_pipeline_cache, 1, &pipeline_create_info, nullptr,
+            &vk_pipeline);
+        if(result != VK_SUCCESS)
+            throw error(result, "failed to create pipeline variant");
+
+        pipelines.emplace(std::move(key), vk_pipeline);
+
+        return vk_pipeline;
+    }
+
+    std::size_t permutation_cache::size() const noexcept {
+        return pipelines.size();
+    }
+
+    std::size_t permutation_cache::constants_hash::operator()(
+        const std::vector<std::uint32_t>& constants) const noexcept
+    {
+        // FNV-1a
+        std::uint64_t hash = 14695981039346656037ull;
+        for(std::uint32_t constant : constants) {
+            hash ^= constant;
+            hash *= 1099511628211ull;
+        }
+
+        return static_cast<std::size_t>(hash);
+    }
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <vector>
+#include <span>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+
+#include <vulkan/vulkan.h>
+
+namespace glowstick::vulkan {
+    // Compute pipeline variants of a single shader, one per distinct set of
+    // specialization constants
+    // Variants are created on first use and shared by every later request with
+    // the same constants
+    class permutation_cache {
+    public:
+        // The pipeline layout is not owned and must outlive the cache
+        explicit permutation_cache(VkDevice vk_device,
+            std::span<const std::uint32_t> code,
+            VkPipelineLayout vk_pipeline_layout);
+        permutation_cache(const permutation_cache&) = delete;
+        permutation_cache(permutation_cache&& other) noexcept;
+
+        permutation_cache& operator=(const permutation_cache&) = delete;
+        permutation_cache& operator=(permutation_cache&& other) noexcept;
+
+        ~permutation_cache();
+
+        // constants[i] is bound to constant_id i
+        // Booleans are passed as VK_TRUE or VK_FALSE
+        VkPipeline get(std::span<const std::uint32_t> constants);
+
+        std::size_t size() const noexcept;
+
+    private:
+        struct constants_hash {
+            std::size_t operator()(
+                const std::vector<std::uint32_t>& constants) const noexcept;
+        };
+
+        VkDevice vk_device;
+        VkShaderModule vk_shader_module;
+        VkPipelineCache vk_pipeline_cache;
+        VkPipelineLayout vk_pipeline_layout;
+        std::unordered_map<std::vector<std::uint32_t>, VkPipeline,
+            constants_hash> pipelines;
+    };
+}
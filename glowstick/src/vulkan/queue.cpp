@@ -24,6 +24,10 @@ namespace glowstick::vulkan {
 
     queue::~queue() = default;
 
+    VkQueue queue::get_handle() const noexcept {
+        return vk_queue;
+    }
+
     std::uint32_t queue::get_family_index() const noexcept {
         return family_index;
     }
@@ -16,6 +16,7 @@ namespace glowstick::vulkan {
 
         ~queue();
 
+        VkQueue get_handle() const noexcept;
         std::uint32_t get_family_index() const noexcept;
 
     private:
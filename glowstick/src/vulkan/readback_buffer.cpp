@@ -0,0 +1,114 @@
+#include "vulkan/readback_buffer.hpp"
+
+#include "vulkan/error.hpp"
+
+namespace glowstick::vulkan {
+    readback_buffer::readback_buffer(device& owner, VkDeviceSize size) :
+        owner(&owner),
+        vk_buffer(VK_NULL_HANDLE),
+        vk_memory(VK_NULL_HANDLE),
+        memory_size(0)
+    {
+        VkResult result;
+        VkDevice vk_device = owner.get_handle();
+
+        // Create the buffer
+
+        VkBufferCreateInfo buffer_create_info{
+            .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+            .size = size,
+            .usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+            .sharingMode = VK_SHARING_MODE_EXCLUSIVE
+        };
+
+        result = vkCreateBuffer(vk_device, &buffer_create_info, nullptr,
+            &vk_buffer);
+        if(result != VK_SUCCESS)
+            throw error(result, "failed to create buffer");
+
+        // Allocate and map the memory
+        // Coherent memory is guaranteed to exist and saves invalidating before
+        // every read, cached memory makes those reads fast
+
+        VkMemoryRequirements requirements;
+        vkGetBufferMemoryRequirements(vk_device, vk_buffer, &requirements);
+
+        try {
+            vk_memory = owner.allocate_memory(requirements,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
+                    | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                VK_MEMORY_PROPERTY_HOST_CACHED_BIT);
+        } catch(...) {
+            vkDestroyBuffer(vk_device, vk_buffer, nullptr);
+            throw;
+        }
+
+        memory_size = requirements.size;
+
+        void* mapped_data = nullptr;
+        result = vkBindBufferMemory(vk_device, vk_buffer, vk_memory, 0);
+        if(result == VK_SUCCESS)
+            result = vkMapMemory(vk_device, vk_memory, 0, VK_WHOLE_SIZE, 0,
+                &mapped_data);
+        if(result != VK_SUCCESS) {
+            owner.free_memory(vk_memory, memory_size);
+            vkDestroyBuffer(vk_device, vk_buffer, nullptr);
+            throw error(result, "failed to map buffer memory");
+        }
+
+        data = std::span(static_cast<const std::byte*>(mapped_data),
+            static_cast<std::size_t>(size));
+    }
+
+    readback_buffer::readback_buffer(readback_buffer&& other) noexcept :
+        owner(other.owner),
+        vk_buffer(other.vk_buffer),
+        vk_memory(other.vk_memory),
+        memory_size(other.memory_size),
+        data(other.data)
+    {
+        other.owner = nullptr;
+        other.vk_buffer = VK_NULL_HANDLE;
+        other.vk_memory = VK_NULL_HANDLE;
+        other.memory_size = 0;
+        other.data = {};
+    }
+
+    readback_buffer& readback_buffer::operator=(
+        readback_buffer&& other) noexcept
+    {
+        owner = other.owner;
+        other.owner = nullptr;
+
+        vk_buffer = other.vk_buffer;
+        other.vk_buffer = VK_NULL_HANDLE;
+
+        vk_memory = other.vk_memory;
+        other.vk_memory = VK_NULL_HANDLE;
+
+        memory_size = other.memory_size;
+        other.memory_size = 0;
+
+        data = other.data;
+        other.data = {};
+
+        return *this;
+    }
+
+    readback_buffer::~readback_buffer() {
+        if(!owner)
+            return;
+
+        // Freeing the memory implicitly unmaps it
+        vkDestroyBuffer(owner->get_handle(), vk_buffer, nullptr);
+        owner->free_memory(vk_memory, memory_size);
+    }
+
+    VkBuffer readback_buffer::get_handle() const noexcept {
+        return vk_buffer;
+    }
+
+    std::span<const std::byte> readback_buffer::get_data() const noexcept {
+        return data;
+    }
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <span>
+#include <cstddef>
+
+#include <vulkan/vulkan.h>
+
+#include "vulkan/device.hpp"
+
+namespace glowstick::vulkan {
+    // Storage buffer in persistently mapped host memory, written by shaders and
+    // read back by the host
+    class readback_buffer {
+    public:
+        // The device must outlive the buffer
+        explicit readback_buffer(device& owner, VkDeviceSize size);
+        readback_buffer(const readback_buffer&) = delete;
+        readback_buffer(readback_buffer&& other) noexcept;
+
+        readback_buffer& operator=(const readback_buffer&) = delete;
+        readback_buffer& operator=(readback_buffer&& other) noexcept;
+
+        ~readback_buffer();
+
+        VkBuffer get_handle() const noexcept;
+        std::span<const std::byte> get_data() const noexcept;
+
+    private:
+        device* owner;
+        VkBuffer vk_buffer;
+        VkDeviceMemory vk_memory;
+        VkDeviceSize memory_size;
+        std::span<const std::byte> data;
+    };
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <span>
+#include <cstdint>
+
+// SPIR-V embedded at build time, see GLOWSTICK_SHADERS in CMakeLists.txt
+// Each shader is named after its source file, e.g. trace.comp -> trace_comp
+
+namespace glowstick::vulkan::shaders {
+    extern const std::span<const std::uint32_t> trace_comp;
+}
@@ -0,0 +1,324 @@
+#include "vulkan/tile_renderer.hpp"
+
+#include <array>
+#include <algorithm>
+#include <limits>
+
+#include "glowstick/error.hpp"
+#include "vulkan/error.hpp"
+
+namespace glowstick::vulkan {
+    namespace {
+        // Two slots let the host drain one tile while the device renders the
+        // other
+        constexpr std::uint32_t slot_count = 2;
+
+        constexpr VkDeviceSize pixel_size = 4;
+    }
+
+    tile_renderer::tile_renderer(device& owner, trace_kernel& kernel,
+        const tiled_render_info& info) :
+        owner(&owner),
+        kernel(&kernel),
+        info(info),
+        vk_pipeline(kernel.get_pipeline(info.settings)),
+        vk_descriptor_pool(VK_NULL_HANDLE),
+        vk_command_pool(VK_NULL_HANDLE)
+    {
+        VkResult result;
+        VkDevice vk_device = owner.get_handle();
+
+        // Images smaller than a tile only need buffers as large as the image
+        VkDeviceSize tile_bytes =
+            static_cast<VkDeviceSize>(std::min(info.tile_size, info.width))
+            * std::min(info.tile_size, info.height) * pixel_size;
+        if(tile_bytes > owner.get_max_storage_buffer_range())
+            throw glowstick::error("tile size exceeds the device limits");
+
+        // Create the pools
+
+        VkDescriptorPoolSize pool_size{
+            .type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .descriptorCount = slot_count
+        };
+
+        VkDescriptorPoolCreateInfo descriptor_pool_create_info{
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+            .maxSets = slot_count,
+            .poolSizeCount = 1,
+            .pPoolSizes = &pool_size
+        };
+
+        result = vkCreateDescriptorPool(vk_device,
+            &descriptor_pool_create_info, nullptr, &vk_descriptor_pool);
+        if(result != VK_SUCCESS)
+            throw error(result, "failed to create descriptor pool");
+
+        VkCommandPoolCreateInfo command_pool_create_info{
+            .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+            .flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+            .queueFamilyIndex =
+                owner.get_graphics_queue().get_family_index()
+        };
+
+        result = vkCreateCommandPool(vk_device, &command_pool_create_info,
+            nullptr, &vk_command_pool);
+        if(result != VK_SUCCESS) {
+            vkDestroyDescriptorPool(vk_device, vk_descriptor_pool, nullptr);
+            throw error(result, "failed to create command pool");
+        }
+
+        // Create the slots
+        // The slots clean up after themselves from here on through the
+        // destructor
+
+        std::array<VkDescriptorSetLayout, slot_count> set_layouts;
+        set_layouts.fill(kernel.get_descriptor_set_layout());
+
+        std::array<VkDescriptorSet, slot_count> descriptor_sets;
+        std::array<VkCommandBuffer, slot_count> command_buffers;
+
+        try {
+            VkDescriptorSetAllocateInfo descriptor_set_allocate_info{
+                .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+                .descriptorPool = vk_descriptor_pool,
+                .descriptorSetCount = slot_count,
+                .pSetLayouts = set_layouts.data()
+            };
+
+            result = vkAllocateDescriptorSets(vk_device,
+                &descriptor_set_allocate_info, descriptor_sets.data());
+            if(result != VK_SUCCESS)
+                throw error(result, "failed to allocate descriptor sets");
+
+            VkCommandBufferAllocateInfo command_buffer_allocate_info{
+                .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+                .commandPool = vk_command_pool,
+                .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+                .commandBufferCount = slot_count
+            };
+
+            result = vkAllocateCommandBuffers(vk_device,
+                &command_buffer_allocate_info, command_buffers.data());
+            if(result != VK_SUCCESS)
+                throw error(result, "failed to allocate command buffers");
+
+            slots.reserve(slot_count);
+            for(std::uint32_t slot_index = 0; slot_index < slot_count;
+                ++slot_index)
+            {
+                readback_buffer buffer(owner, tile_bytes);
+
+                VkDescriptorBufferInfo buffer_info{
+                    .buffer = buffer.get_handle(),
+                    .offset = 0,
+                    .range = VK_WHOLE_SIZE
+                };
+
+                VkWriteDescriptorSet descriptor_write{
+                    .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                    .dstSet = descriptor_sets[slot_index],
+                    .dstBinding = 0,
+                    .descriptorCount = 1,
+                    .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                    .pBufferInfo = &buffer_info
+                };
+
+                vkUpdateDescriptorSets(vk_device, 1, &descriptor_write, 0,
+                    nullptr);
+
+                // Fences start signaled so every slot is ready for its first
+                // tile
+                VkFenceCreateInfo fence_create_info{
+                    .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+                    .flags = VK_FENCE_CREATE_SIGNALED_BIT
+                };
+
+                VkFence vk_fence;
+                result = vkCreateFence(vk_device, &fence_create_info, nullptr,
+                    &vk_fence);
+                if(result != VK_SUCCESS)
+                    throw error(result, "failed to create fence");
+
+                slots.push_back({
+                    .buffer = std::move(buffer),
+                    .vk_descriptor_set = descriptor_sets[slot_index],
+                    .vk_command_buffer = command_buffers[slot_index],
+                    .vk_fence = vk_fence
+                });
+            }
+        } catch(...) {
+            for(auto& tile_slot : slots)
+                vkDestroyFence(vk_device, tile_slot.vk_fence, nullptr);
+
+            vkDestroyCommandPool(vk_device, vk_command_pool, nullptr);
+            vkDestroyDescriptorPool(vk_device, vk_descriptor_pool, nullptr);
+            throw;
+        }
+    }
+
+    tile_renderer::~tile_renderer() {
+        VkDevice vk_device = owner->get_handle();
+
+        // Tiles may still be in flight if a sink threw
+        std::vector<VkFence> pending_fences;
+        for(auto& tile_slot : slots) {
+            if(tile_slot.pending)
+                pending_fences.push_back(tile_slot.vk_fence);
+        }
+
+        if(!pending_fences.empty())
+            vkWaitForFences(vk_device,
+                static_cast<std::uint32_t>(pending_fences.size()),
+                pending_fences.data(), VK_TRUE,
+                std::numeric_limits<std::uint64_t>::max());
+
+        for(auto& tile_slot : slots)
+            vkDestroyFence(vk_device, tile_slot.vk_fence, nullptr);
+
+        vkDestroyCommandPool(vk_device, vk_command_pool, nullptr);
+        vkDestroyDescriptorPool(vk_device, vk_descriptor_pool, nullptr);
+    }
+
+    std::size_t tile_renderer::render(const tile_sink& sink) {
+        // Tiles are visited in row major order, tiles on the right and bottom
+        // edges are cropped to the image
+
+        std::size_t tile_index = 0;
+        for(std::uint32_t y = 0; y < info.height; y += info.tile_size) {
+            for(std::uint32_t x = 0; x < info.width; x += info.tile_size) {
+                region tile_region{
+                    .x = x,
+                    .y = y,
+                    .width = std::min(info.tile_size, info.width - x),
+                    .height = std::min(info.tile_size, info.height - y)
+                };
+
+                // Hand off the oldest tile before reusing its slot
+                slot& tile_slot = slots[tile_index % slots.size()];
+                if(tile_slot.pending)
+                    retire(tile_slot, sink);
+
+                submit(tile_slot, tile_region);
+                ++tile_index;
+
+                // Stop before the unsigned coordinates wrap around
+                if(info.width - x <= info.tile_size)
+                    break;
+            }
+
+            if(info.height - y <= info.tile_size)
+                break;
+        }
+
+        // Drain the tiles still in flight, oldest first
+        for(std::size_t index = tile_index; index < tile_index + slots.size();
+            ++index)
+        {
+            slot& tile_slot = slots[index % slots.size()];
+            if(tile_slot.pending)
+                retire(tile_slot, sink);
+        }
+
+        return tile_index;
+    }
+
+    void tile_renderer::submit(slot& tile_slot, const region& tile_region) {
+        VkResult result;
+        VkCommandBuffer vk_command_buffer = tile_slot.vk_command_buffer;
+
+        // Record the tile
+
+        result = vkResetCommandBuffer(vk_command_buffer, 0);
+        if(result != VK_SUCCESS)
+            throw error(result, "failed to reset command buffer");
+
+        VkCommandBufferBeginInfo begin_info{
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+            .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT
+        };
+
+        result = vkBeginCommandBuffer(vk_command_buffer, &begin_info);
+        if(result != VK_SUCCESS)
+            throw error(result, "failed to begin command buffer");
+
+        vkCmdBindPipeline(vk_command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+            vk_pipeline);
+        vkCmdBindDescriptorSets(vk_command_buffer,
+            VK_PIPELINE_BIND_POINT_COMPUTE, kernel->get_pipeline_layout(), 0,
+            1, &tile_slot.vk_descriptor_set, 0, nullptr);
+
+        trace_kernel::push_constants constants{
+            .image_extent = {info.width, info.height},
+            .region_offset = {tile_region.x, tile_region.y},
+            .region_extent = {tile_region.width, tile_region.height}
+        };
+
+        vkCmdPushConstants(vk_command_buffer, kernel->get_pipeline_layout(),
+            VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(constants), &constants);
+
+        vkCmdDispatch(vk_command_buffer,
+            (tile_region.width + trace_kernel::group_size - 1)
+                / trace_kernel::group_size,
+            (tile_region.height + trace_kernel::group_size - 1)
+                / trace_kernel::group_size,
+            1);
+
+        // Make the shader writes visible to the host once the fence signals
+        VkMemoryBarrier barrier{
+            .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+            .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+            .dstAccessMask = VK_ACCESS_HOST_READ_BIT
+        };
+
+        vkCmdPipelineBarrier(vk_command_buffer,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+            0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+        result = vkEndCommandBuffer(vk_command_buffer);
+        if(result != VK_SUCCESS)
+            throw error(result, "failed to end command buffer");
+
+        // Submit the tile
+
+        VkDevice vk_device = owner->get_handle();
+
+        result = vkResetFences(vk_device, 1, &tile_slot.vk_fence);
+        if(result != VK_SUCCESS)
+            throw error(result, "failed to reset fence");
+
+        VkSubmitInfo submit_info{
+            .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+            .commandBufferCount = 1,
+            .pCommandBuffers = &vk_command_buffer
+        };
+
+        result = vkQueueSubmit(owner->get_graphics_queue().get_handle(), 1,
+            &submit_info, tile_slot.vk_fence);
+        if(result != VK_SUCCESS)
+            throw error(result, "failed to submit tile");
+
+        tile_slot.pending = tile_region;
+    }
+
+    void tile_renderer::retire(slot& tile_slot, const tile_sink& sink) {
+        VkResult result = vkWaitForFences(owner->get_handle(), 1,
+            &tile_slot.vk_fence, VK_TRUE,
+            std::numeric_limits<std::uint64_t>::max());
+        if(result != VK_SUCCESS)
+            throw error(result, "failed to wait for tile");
+
+        region tile_region = tile_slot.pending.value();
+        tile_slot.pending.reset();
+
+        sink(tile{
+            .x = tile_region.x,
+            .y = tile_region.y,
+            .width = tile_region.width,
+            .height = tile_region.height,
+            .pixels = tile_slot.buffer.get_data().first(
+                static_cast<std::size_t>(tile_region.width)
+                    * tile_region.height * pixel_size)
+        });
+    }
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <vector>
+#include <optional>
+#include <cstdint>
+#include <cstddef>
+
+#include <vulkan/vulkan.h>
+
+#include "glowstick/renderer.hpp"
+#include "vulkan/device.hpp"
+#include "vulkan/readback_buffer.hpp"
+#include "vulkan/trace_kernel.hpp"
+
+namespace glowstick::vulkan {
+    // Renders an image as a sequence of fixed size tiles
+    // Only a few tiles worth of memory is allocated no matter the image size,
+    // and a finished tile is handed to the sink while the next one renders
+    class tile_renderer {
+    public:
+        // The device and kernel must outlive the tile renderer
+        // Buffers and the pipeline are set up here so render only renders
+        explicit tile_renderer(device& owner, trace_kernel& kernel,
+            const tiled_render_info& info);
+        tile_renderer(const tile_renderer&) = delete;
+
+        tile_renderer& operator=(const tile_renderer&) = delete;
+
+        ~tile_renderer();
+
+        // Returns the number of tiles rendered
+        std::size_t render(const tile_sink& sink);
+
+    private:
+        struct region {
+            std::uint32_t x;
+            std::uint32_t y;
+            std::uint32_t width;
+            std::uint32_t height;
+        };
+
+        // Everything one tile in flight needs
+        struct slot {
+            readback_buffer buffer;
+            VkDescriptorSet vk_descriptor_set;
+            VkCommandBuffer vk_command_buffer;
+            VkFence vk_fence;
+            std::optional<region> pending;
+        };
+
+        void submit(slot& tile_slot, const region& tile_region);
+        void retire(slot& tile_slot, const tile_sink& sink);
+
+        device* owner;
+        trace_kernel* kernel;
+        tiled_render_info info;
+        VkPipeline vk_pipeline;
+        VkDescriptorPool vk_descriptor_pool;
+        VkCommandPool vk_command_pool;
+        std::vector<slot> slots;
+    };
+}
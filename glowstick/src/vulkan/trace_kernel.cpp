@@ -0,0 +1,103 @@
+#include "vulkan/trace_kernel.hpp"
+
+#include "vulkan/error.hpp"
+#include "vulkan/shaders.hpp"
+
+namespace glowstick::vulkan {
+    trace_kernel::trace_kernel(VkDevice vk_device) :
+        vk_device(vk_device),
+        vk_descriptor_set_layout(VK_NULL_HANDLE),
+        vk_pipeline_layout(VK_NULL_HANDLE)
+    {
+        VkResult result;
+
+        // Create the descriptor set layout
+
+        VkDescriptorSetLayoutBinding output_binding{
+            .binding = 0,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT
+        };
+
+        VkDescriptorSetLayoutCreateInfo descriptor_set_layout_create_info{
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+            .bindingCount = 1,
+            .pBindings = &output_binding
+        };
+
+        result = vkCreateDescriptorSetLayout(vk_device,
+            &descriptor_set_layout_create_info, nullptr,
+            &vk_descriptor_set_layout);
+        if(result != VK_SUCCESS)
+            throw error(result, "failed to create descriptor set layout");
+
+        // Create the pipeline layout
+
+        VkPushConstantRange push_constant_range{
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+            .offset = 0,
+            .size = sizeof(push_constants)
+        };
+
+        VkPipelineLayoutCreateInfo pipeline_layout_create_info{
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+            .setLayoutCount = 1,
+            .pSetLayouts = &vk_descriptor_set_layout,
+            .pushConstantRangeCount = 1,
+            .pPushConstantRanges = &push_constant_range
+        };
+
+        result = vkCreatePipelineLayout(vk_device,
+            &pipeline_layout_create_info, nullptr, &vk_pipeline_layout);
+        if(result != VK_SUCCESS) {
+            vkDestroyDescriptorSetLayout(vk_device, vk_descriptor_set_layout,
+                nullptr);
+            throw error(result, "failed to create pipeline layout");
+        }
+
+        try {
+            pipelines.emplace(vk_device, shaders::trace_comp,
+                vk_pipeline_layout);
+        } catch(...) {
+            vkDestroyPipelineLayout(vk_device, vk_pipeline_layout, nullptr);
+            vkDestroyDescriptorSetLayout(vk_device, vk_descriptor_set_layout,
+                nullptr);
+            throw;
+        }
+    }
+
+    trace_kernel::~trace_kernel() {
+        // The pipelines have to go before their layout
+        pipelines.reset();
+
+        vkDestroyPipelineLayout(vk_device, vk_pipeline_layout, nullptr);
+        vkDestroyDescriptorSetLayout(vk_device, vk_descriptor_set_layout,
+            nullptr);
+    }
+
+    VkDescriptorSetLayout trace_kernel::get_descriptor_set_layout() const
+        noexcept
+    {
+        return vk_descriptor_set_layout;
+    }
+
+    VkPipelineLayout trace_kernel::get_pipeline_layout() const noexcept {
+        return vk_pipeline_layout;
+    }
+
+    VkPipeline trace_kernel::get_pipeline(const render_settings& settings) {
+        // Ordered by constant_id in trace.comp
+        std::array<std::uint32_t, 3> constants{
+            settings.max_bounces,
+            settings.samples_per_pixel,
+            settings.russian_roulette ? VK_TRUE : VK_FALSE
+        };
+
+        return pipelines->get(constants);
+    }
+
+    std::size_t trace_kernel::get_pipeline_count() const noexcept {
+        return pipelines->size();
+    }
+}
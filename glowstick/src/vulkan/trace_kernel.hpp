@@ -0,0 +1,47 @@
+#pragma once
+
+#include <array>
+#include <optional>
+#include <cstdint>
+#include <cstddef>
+
+#include <vulkan/vulkan.h>
+
+#include "glowstick/renderer.hpp"
+#include "vulkan/permutation_cache.hpp"
+
+namespace glowstick::vulkan {
+    // The trace.comp shader and its layouts
+    // Writes one region of the image into the storage buffer at set 0,
+    // binding 0
+    class trace_kernel {
+    public:
+        // Matches the push constant block in trace.comp
+        struct push_constants {
+            std::array<std::uint32_t, 2> image_extent;
+            std::array<std::uint32_t, 2> region_offset;
+            std::array<std::uint32_t, 2> region_extent;
+        };
+
+        // Matches local_size in trace.comp
+        static constexpr std::uint32_t group_size = 8;
+
+        explicit trace_kernel(VkDevice vk_device);
+        trace_kernel(const trace_kernel&) = delete;
+
+        trace_kernel& operator=(const trace_kernel&) = delete;
+
+        ~trace_kernel();
+
+        VkDescriptorSetLayout get_descriptor_set_layout() const noexcept;
+        VkPipelineLayout get_pipeline_layout() const noexcept;
+        VkPipeline get_pipeline(const render_settings& settings);
+        std::size_t get_pipeline_count() const noexcept;
+
+    private:
+        VkDevice vk_device;
+        VkDescriptorSetLayout vk_descriptor_set_layout;
+        VkPipelineLayout vk_pipeline_layout;
+        std::optional<permutation_cache> pipelines;
+    };
+}
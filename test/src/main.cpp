@@ -1,13 +1,172 @@
 #include <glowstick/glowstick.hpp>
 
 #include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+namespace {
+    bool failed = false;
+
+    void check(bool condition, std::string_view message) {
+        if(!condition) {
+            std::cerr << "check failed: " << message << std::endl;
+            failed = true;
+        }
+    }
+
+    // Copies a tile into an RGBA8 image with tightly packed rows
+    void copy_tile(const glowstick::tile& finished_tile,
+        std::uint32_t image_width, std::vector<std::byte>& image)
+    {
+        std::size_t tile_row_size =
+            static_cast<std::size_t>(finished_tile.width) * 4;
+
+        for(std::uint32_t row = 0; row < finished_tile.height; ++row) {
+            std::memcpy(
+                image.data() + ((finished_tile.y + row)
+                    * static_cast<std::size_t>(image_width) + finished_tile.x)
+                    * 4,
+                finished_tile.pixels.data() + row * tile_row_size,
+                tile_row_size);
+        }
+    }
+}
 
 int main(int argc, char* argv[]) {
     try {
         glowstick::renderer renderer;
+
+        // Pipeline variants are built once per distinct set of settings
+
+        glowstick::tiled_render_info info{
+            .width = 64,
+            .height = 64,
+            .tile_size = 64
+        };
+
+        auto discard = [](const glowstick::tile&) {};
+
+        glowstick::render_stats first = renderer.render_tiled(info, discard);
+        check(first.pipeline_variants == 1, "first render builds a variant");
+
+        glowstick::render_stats repeat = renderer.render_tiled(info, discard);
+        check(repeat.pipeline_variants == 1,
+            "same settings reuse the variant");
+
+        info.settings.max_bounces = 2;
+        glowstick::render_stats changed = renderer.render_tiled(info,
+            discard);
+        check(changed.pipeline_variants == 2,
+            "new settings build a new variant");
+
+        // Tiles cover every pixel exactly once, including the cropped tiles on
+        // the right and bottom edges
+
+        glowstick::tiled_render_info cropped_info{
+            .width = 200,
+            .height = 130,
+            .tile_size = 64
+        };
+
+        std::vector<std::uint32_t> coverage(
+            cropped_info.width * cropped_info.height);
+        std::vector<std::byte> tiled_image(
+            cropped_info.width * cropped_info.height * 4);
+        std::size_t sink_calls = 0;
+
+        glowstick::render_stats cropped = renderer.render_tiled(cropped_info,
+            [&](const glowstick::tile& finished_tile) {
+                ++sink_calls;
+
+                check(finished_tile.pixels.size()
+                    == finished_tile.width * finished_tile.height * 4,
+                    "tile pixels are tightly packed");
+
+                for(std::uint32_t y = finished_tile.y;
+                    y < finished_tile.y + finished_tile.height; ++y)
+                {
+                    for(std::uint32_t x = finished_tile.x;
+                        x < finished_tile.x + finished_tile.width; ++x)
+                        ++coverage[y * cropped_info.width + x];
+                }
+
+                copy_tile(finished_tile, cropped_info.width, tiled_image);
+            });
+
+        check(cropped.tile_count == 12, "200x130 splits into 4x3 tiles");
+        check(sink_calls == cropped.tile_count,
+            "every tile reaches the sink");
+
+        bool covered_once = true;
+        for(std::uint32_t count : coverage)
+            covered_once = covered_once && count == 1;
+        check(covered_once, "tiles cover every pixel exactly once");
+
+        // Peak device memory depends on the tile size, not the image size
+        // Each of the two tiles in flight may be padded by the allocator
+
+        std::uint64_t tile_bytes = 2 * 64 * 64 * 4;
+        check(cropped.peak_device_memory == first.peak_device_memory,
+            "peak device memory does not grow with the image");
+        check(cropped.peak_device_memory >= tile_bytes
+            && cropped.peak_device_memory < tile_bytes + 2 * 65536,
+            "peak device memory is two tiles");
+
+        // The pixels do not depend on how the image is split into tiles
+
+        glowstick::tiled_render_info single_tile_info = cropped_info;
+        single_tile_info.tile_size = 256;
+
+        std::vector<std::byte> single_tile_image(tiled_image.size());
+
+        glowstick::render_stats single_tile = renderer.render_tiled(
+            single_tile_info, [&](const glowstick::tile& finished_tile) {
+                copy_tile(finished_tile, single_tile_info.width,
+                    single_tile_image);
+            });
+
+        check(single_tile.tile_count == 1, "200x130 fits in one 256 tile");
+        check(single_tile_image == tiled_image,
+            "tiled and single tile renders match");
+
+        // The PAM overload writes a header followed by the RGBA8 pixels
+
+        std::filesystem::path path = std::filesystem::temp_directory_path()
+            / "glowstick_test.pam";
+
+        renderer.render_tiled(cropped_info, path);
+
+        std::string header = "P7\nWIDTH 200\nHEIGHT 130\nDEPTH 4\nMAXVAL 255"
+            "\nTUPLTYPE RGB_ALPHA\nENDHDR\n";
+
+        check(std::filesystem::file_size(path)
+            == header.size() + cropped_info.width * cropped_info.height * 4,
+            "PAM file has the header and every pixel");
+
+        std::string file_header(header.size(), '\0');
+        std::ifstream(path, std::ios::binary).read(file_header.data(),
+            static_cast<std::streamsize>(file_header.size()));
+        check(file_header == header, "PAM file starts with the header");
+
+        std::vector<std::byte> file_pixels(tiled_image.size());
+        std::ifstream file(path, std::ios::binary);
+        file.seekg(static_cast<std::streamoff>(header.size()));
+        file.read(reinterpret_cast<char*>(file_pixels.data()),
+            static_cast<std::streamsize>(file_pixels.size()));
+        file.close();
+        check(file_pixels == tiled_image, "PAM pixels match the sink output");
+
+        std::filesystem::remove(path);
     } catch(glowstick::error& e) {
         std::cerr << e.what() << std::endl;
+        failed = true;
     }
 
-    return 0;
+    return failed ? 1 : 0;
 }